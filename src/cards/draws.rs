@@ -1,37 +1,81 @@
 use std::cmp;
-use std::hash::Hash;
+
+use lazy_static::lazy_static;
 
 use super::Cards;
 
+/// The largest `n` for which binomial coefficients are precomputed.
+/// (All C(n, k) with n <= 64 fit in a u64.)
+const MAX_BINOMIAL_N: usize = 64;
+
+lazy_static! {
+    /// Pascal's triangle of binomial coefficients: `BINOMIAL[n][k]` = C(n, k).
+    static ref BINOMIAL: Box<[[u64; MAX_BINOMIAL_N + 1]; MAX_BINOMIAL_N + 1]> = {
+        let mut table = Box::new([[0; MAX_BINOMIAL_N + 1]; MAX_BINOMIAL_N + 1]);
+        for n in 0..=MAX_BINOMIAL_N {
+            table[n][0] = 1;
+            for k in 1..=n {
+                table[n][k] = table[n - 1][k - 1] + table[n - 1][k];
+            }
+        }
+        table
+    };
+}
+
+/// Returns C(n, k) by table lookup, falling back to computing it for `n`
+/// beyond the precomputed range.
+fn binomial(n: usize, k: usize) -> u64 {
+    if n <= MAX_BINOMIAL_N {
+        BINOMIAL[n][k]
+    } else {
+        // card sets this large are not expected in practice
+        num_integer::binomial(n as u64, k as u64)
+    }
+}
+
 /// An iterator that enumerates unique draws from a [`Cards`].
 /// See [`Cards::enumerate_draws`] for details.
 /// (Note: There may be room to optimize this.)
 #[derive(Clone)]
 #[must_use = "iterators are lazy and do nothing unless consumed"]
-pub struct Draws<CardType> {
+pub struct Draws<CardType: Ord> {
     /// The reciprocal of the denominator in the probability calculation.
     prob_denom_recip: f64,
-    /// A "stack" of states for each card type.
-    states: Vec<CardTypeState<CardType>>,
+    /// The card type for each stack level. Kept separate from `states` so
+    /// the numeric fields the DFS touches on every step stay densely packed.
+    card_types: Vec<CardType>,
+    /// A "stack" of states, one per card type (parallel to `card_types`).
+    states: Vec<LevelState>,
     /// The current index into `states`.
     index: isize,
+    /// The deck minus the cards currently drawn by the stack.
+    /// Maintained incrementally as draw counts change.
+    reduced_deck: Cards<CardType>,
+    /// The cards currently drawn by the stack.
+    /// Maintained incrementally as draw counts change.
+    drawn_cards: Cards<CardType>,
 }
 
 #[derive(Clone)]
-struct CardTypeState<CardType> {
-    card_type: CardType,
+struct LevelState {
     num_in_deck: usize,
     n_remaining: usize,
     num_drawn: usize,
+    /// The running product of `C(num_in_deck, num_drawn)` over this state and
+    /// all states before it in the stack.
+    prob_numerator: f64,
 }
 
-impl<CardType: Hash + Eq + Copy> Draws<CardType> {
+impl<CardType: Ord + Copy> Draws<CardType> {
     pub(super) fn new(cards: &Cards<CardType>, n: usize) -> Self {
         if cards.is_empty() {
             return Self {
                 prob_denom_recip: 1.0, // arbitrary; will not be used
+                card_types: Vec::new(),
                 states: Vec::new(),
                 index: 0,
+                reduced_deck: Cards::new(),
+                drawn_cards: Cards::new(),
             };
         }
 
@@ -39,56 +83,81 @@ impl<CardType: Hash + Eq + Copy> Draws<CardType> {
         // only draw up to the total number of cards
         let n = cmp::min(n, total_cards);
 
-        let prob_denom = num_integer::binomial(total_cards, n);
+        let prob_denom = binomial(total_cards, n);
+
+        // The DFS fills the draw counts of the last states first, so ordering
+        // the stack by ascending count makes the likeliest combinations (those
+        // drawing mostly from the most-plentiful types) come out first. This
+        // helps callers that process or cut off the enumeration by probability
+        // mass.
+        let mut type_counts: Vec<_> = cards.cards.clone();
+        type_counts.sort_by_key(|&(_, count)| count);
+
+        let (card_types, states) = type_counts
+            .into_iter()
+            .map(|(card_type, count)| {
+                let state = LevelState {
+                    num_in_deck: count,
+                    n_remaining: n,
+                    num_drawn: 0,
+                    prob_numerator: 1.0, // C(num_in_deck, 0) == 1
+                };
+                (card_type, state)
+            })
+            .unzip();
 
         Self {
             prob_denom_recip: 1.0 / (prob_denom as f64),
-            states: cards.cards.iter()
-                .map(|(&card_type, &count)| {
-                    CardTypeState {
-                        card_type,
-                        num_in_deck: count,
-                        n_remaining: n,
-                        num_drawn: 0,
-                    }
-                })
-                .collect(),
+            card_types,
+            states,
             index: 0,
+            reduced_deck: cards.clone(),
+            drawn_cards: Cards {
+                // preallocate for the worst case (every type drawn at once)
+                // so the enumeration loop never reallocates
+                cards: Vec::with_capacity(cards.cards.len()),
+            },
         }
     }
 
     /// Constructs a result tuple from the current state of the iterator.
     /// Also calls `end_loop()` to prepare for the next iteration.
     fn make_result(&mut self) -> (Cards<CardType>, Cards<CardType>, f64) {
-        let mut reduced_deck = Cards::new();
-        let mut drawn_cards = Cards::new();
-        let mut prob_numerator = 1.0;
+        // the deck/drawn multisets and the probability numerator are all
+        // maintained incrementally, so a result is just a pair of clones
         let i = self.index as usize;
-        for state in &self.states[..=i] {
-            drawn_cards.add(state.card_type, state.num_drawn);
-            reduced_deck.add(state.card_type, state.num_in_deck - state.num_drawn);
-
-            // note: these binomial coefficients could be computed incrementally
-            // a la dynamic programming, which may(?) be faster in many(?) cases
-            let b = num_integer::binomial(state.num_in_deck, state.num_drawn);
-            prob_numerator *= b as f64;
-        }
-        for state in &self.states[i+1..] {
-            reduced_deck.add(state.card_type, state.num_in_deck);
-        }
-        let prob = prob_numerator * self.prob_denom_recip;
+        let prob = self.states[i].prob_numerator * self.prob_denom_recip;
+        let result = (self.reduced_deck.clone(), self.drawn_cards.clone(), prob);
 
         self.end_loop();
-        (reduced_deck, drawn_cards, prob)
+        result
     }
 
     /// Helper function which advances one or more of the "recursive" loops.
     fn end_loop(&mut self) {
         // draw another of this type of card (and loop again if not done)
         while self.index >= 0 && {
-            let state = &mut self.states[self.index as usize];
+            let i = self.index as usize;
+            let prev_numerator = if i == 0 { 1.0 } else { self.states[i - 1].prob_numerator };
+            let card_type = self.card_types[i];
+            let state = &mut self.states[i];
             state.num_drawn += 1;
-            state.num_drawn > cmp::min(state.n_remaining, state.num_in_deck)
+            if state.num_drawn > cmp::min(state.n_remaining, state.num_in_deck) {
+                // return this level's drawn cards to the deck before
+                // "returning" up a level
+                let num_moved = state.num_drawn - 1;
+                self.drawn_cards.remove(card_type, num_moved);
+                self.reduced_deck.add(card_type, num_moved);
+                true
+            } else {
+                // move one card of this type from the deck to the drawn cards
+                self.reduced_deck.remove_one(card_type);
+                self.drawn_cards.add_one(card_type);
+                // update this level's running probability numerator
+                state.prob_numerator =
+                    prev_numerator * binomial(state.num_in_deck, state.num_drawn) as f64;
+                false
+            }
         } {
             // tried every count of this type of card; "return" up a level
             self.index -= 1;
@@ -96,7 +165,7 @@ impl<CardType: Hash + Eq + Copy> Draws<CardType> {
     }
 }
 
-impl<CardType: Hash + Eq + Copy> Iterator for Draws<CardType> {
+impl<CardType: Ord + Copy> Iterator for Draws<CardType> {
     type Item = (Cards<CardType>, Cards<CardType>, f64);
 
     fn next(&mut self) -> Option<Self::Item> {
@@ -126,9 +195,12 @@ impl<CardType: Hash + Eq + Copy> Iterator for Draws<CardType> {
                     self.index -= 1;
                 } else {
                     // recurse to try drawing more cards of different types
-                    let state = &mut self.states[self.index as usize];
+                    let i = self.index as usize;
+                    let prev_numerator = self.states[i - 1].prob_numerator;
+                    let state = &mut self.states[i];
                     state.n_remaining = remaining;
                     state.num_drawn = 0;
+                    state.prob_numerator = prev_numerator; // C(num_in_deck, 0) == 1
                     continue;
                 }
             }
@@ -1,24 +1,24 @@
 mod draws;
 
-use rand::seq::SliceRandom;
-use std::collections::{hash_map::Entry, HashMap};
-use std::hash::Hash;
+use rand::Rng;
 
 use self::draws::Draws;
 
 /// A multiset of cards.
-#[derive(Debug, PartialEq, Eq)]
-pub struct Cards<CardType: Hash + Eq> {
-    /// A mapping from card types to the number of cards of that type.
-    cards: HashMap<CardType, usize>,
+///
+/// Counts are stored in a small vector sorted by card type, so equality,
+/// hashing, and cloning are cheap and iteration order is deterministic.
+#[derive(Debug, Clone, PartialEq, Eq, Hash)]
+pub struct Cards<CardType: Ord> {
+    /// A sorted list of (card type, count) pairs.
+    /// Invariant: sorted by card type, with no duplicates and no zero counts.
+    cards: Vec<(CardType, usize)>,
 }
 
-impl<CardType: Hash + Eq + Copy> Cards<CardType> {
+impl<CardType: Ord + Copy> Cards<CardType> {
     /// Creates a new, empty [`Cards`].
     pub fn new() -> Self {
-        Self {
-            cards: HashMap::new(),
-        }
+        Self { cards: Vec::new() }
     }
 
     /// Adds 1 of the given [`CardType`] to the [`Cards`].
@@ -31,10 +31,10 @@ impl<CardType: Hash + Eq + Copy> Cards<CardType> {
         if n == 0 {
             return; // adding 0 cards is a no-op
         }
-        self.cards
-            .entry(card_type)
-            .and_modify(|e| *e += n)
-            .or_insert(n);
+        match self.cards.binary_search_by(|(ct, _)| ct.cmp(&card_type)) {
+            Ok(index) => self.cards[index].1 += n,
+            Err(index) => self.cards.insert(index, (card_type, n)),
+        }
     }
 
     /// Removes 1 of the given [`CardType`] from the [`Cards`].
@@ -50,21 +50,29 @@ impl<CardType: Hash + Eq + Copy> Cards<CardType> {
     /// # Panics
     /// Panics if there are less than `n` of the given [`CardType`] in the [`Cards`].
     pub fn remove(&mut self, card_type: CardType, n: usize) {
+        // the panic formatting lives in a #[cold] function so the hot
+        // decrement path is just the binary search and a subtract
+        #[cold]
+        #[inline(never)]
+        fn removed_too_many(n: usize, count: usize) -> ! {
+            panic!("Tried to remove {n} of a card type from a Cards, but only {count} present");
+        }
+
         if n == 0 {
             return; // removing 0 cards is a no-op
         }
-        let entry = self.cards.entry(card_type);
-        if let Entry::Occupied(mut o) = entry {
-            let count = o.get_mut();
-            if *count < n {
-                panic!("Tried to remove {n} of a card type from a Cards, but only {count} present");
+        match self.cards.binary_search_by(|(ct, _)| ct.cmp(&card_type)) {
+            Ok(index) => {
+                let count = &mut self.cards[index].1;
+                if *count < n {
+                    removed_too_many(n, *count);
+                }
+                *count -= n;
+                if *count == 0 {
+                    self.cards.remove(index);
+                }
             }
-            *count -= n;
-            if *count == 0 {
-                o.remove();
-            }
-        } else {
-            panic!("Tried to remove {n} of a card type from a Cards, but none present");
+            Err(_) => removed_too_many(n, 0),
         }
     }
 
@@ -74,15 +82,20 @@ impl<CardType: Hash + Eq + Copy> Cards<CardType> {
     /// Panics if the [`CardType`] is not present in the [`Cards`].
     #[allow(dead_code)]
     pub fn remove_all(&mut self, card_type: CardType) {
-        if self.cards.remove(&card_type).is_none() {
-            panic!("Tried to remove all cards of a type from a Cards, but none present");
+        match self.cards.binary_search_by(|(ct, _)| ct.cmp(&card_type)) {
+            Ok(index) => {
+                self.cards.remove(index);
+            }
+            Err(_) => {
+                panic!("Tried to remove all cards of a type from a Cards, but none present")
+            }
         }
     }
 
     /// Returns the number of cards in the [`Cards`], counting duplicates.
     #[allow(dead_code)]
     pub fn count(&self) -> usize {
-        self.cards.values().sum()
+        self.cards.iter().map(|(_, count)| count).sum()
     }
 
     /// Returns the number of unique [`CardType`]s in the [`Cards`].
@@ -101,24 +114,37 @@ impl<CardType: Hash + Eq + Copy> Cards<CardType> {
     /// Returns the updated [`Cards`], and the drawn [`Cards`].
     #[allow(dead_code)]
     pub fn draw_random(&self, n: usize) -> (Cards<CardType>, Cards<CardType>) {
-        // create a list of all the cards, with repetitions
-        let mut card_list = Vec::new();
-        for (card_type, count) in &self.cards {
-            for _ in 0..*count {
-                card_list.push(*card_type);
-            }
-        }
-
-        if n >= card_list.len() {
+        let mut total = self.count();
+        if n >= total {
             // we're drawing as many cards as we have or more, so just draw all
             return (Cards::new(), self.clone());
         }
 
-        // shuffle and split the card list
-        card_list.partial_shuffle(&mut rand::thread_rng(), n);
-        let drawn = &card_list[..n];
-        let rest = &card_list[n..];
-        (Cards::from_iter(drawn), Cards::from_iter(rest))
+        // Sample the counts directly from the multiset: each draw picks a
+        // uniform card index among those remaining and walks the counts to
+        // find which type it falls in. This avoids materializing and
+        // shuffling a list with one entry per card.
+        let mut rng = crate::rng::fast_rng();
+        let mut reduced = self.clone();
+        let mut drawn = Cards::new();
+        for _ in 0..n {
+            let mut index = rng.gen_range(0..total);
+            let (card_type, _) = reduced
+                .iter()
+                .find(|&(_, count)| {
+                    if index < count {
+                        true
+                    } else {
+                        index -= count;
+                        false
+                    }
+                })
+                .expect("card index out of range");
+            reduced.remove_one(card_type);
+            drawn.add_one(card_type);
+            total -= 1;
+        }
+        (reduced, drawn)
     }
 
     /// Returns an iterator that enumerates the possible unique draws of `n`
@@ -139,34 +165,25 @@ impl<CardType: Hash + Eq + Copy> Cards<CardType> {
         Draws::new(self, n)
     }
 
-    /// Returns an iterator over the unique card types in the [`Cards`].
-    /// The order of the types is not defined.
+    /// Returns an iterator over the unique card types in the [`Cards`],
+    /// in sorted order.
     pub fn iter_unique(&self) -> impl Iterator<Item = CardType> + '_ {
-        self.cards.keys().copied()
+        self.cards.iter().map(|(card_type, _)| *card_type)
     }
 
-    /// Returns an iterator over (`CardType`, count) pairs.
-    /// The order is not defined.
+    /// Returns an iterator over (`CardType`, count) pairs, in sorted order.
     pub fn iter(&self) -> impl Iterator<Item = (CardType, usize)> + '_ {
-        self.cards.iter().map(|(key, count)| (*key, *count))
-    }
-}
-
-impl<CardType: Hash + Eq + Clone> Clone for Cards<CardType> {
-    fn clone(&self) -> Self {
-        Self {
-            cards: self.cards.clone(),
-        }
+        self.cards.iter().copied()
     }
 }
 
-impl<CardType: Hash + Eq + Copy> Default for Cards<CardType> {
+impl<CardType: Ord + Copy> Default for Cards<CardType> {
     fn default() -> Self {
         Self::new()
     }
 }
 
-impl<'iter, CardType: 'iter + Hash + Eq + Copy> FromIterator<&'iter CardType> for Cards<CardType> {
+impl<'iter, CardType: 'iter + Ord + Copy> FromIterator<&'iter CardType> for Cards<CardType> {
     fn from_iter<I>(iter: I) -> Self
     where
         I: IntoIterator<Item = &'iter CardType>,
@@ -179,7 +196,7 @@ impl<'iter, CardType: 'iter + Hash + Eq + Copy> FromIterator<&'iter CardType> fo
     }
 }
 
-impl<CardType: Hash + Eq + Copy> FromIterator<CardType> for Cards<CardType> {
+impl<CardType: Ord + Copy> FromIterator<CardType> for Cards<CardType> {
     fn from_iter<I>(iter: I) -> Self
     where
         I: IntoIterator<Item = CardType>,
@@ -1,5 +1,6 @@
 mod cards;
 mod radlands;
+mod rng;
 mod ui;
 
 use clap::Parser;
@@ -118,12 +119,20 @@ fn do_game(
     }
 }
 
-pub fn play_to_end<'ctype>(
+// These functions are generic over the controller types (rather than taking
+// `&mut dyn PlayerController`) so that the rollout loop, which always uses
+// concrete controllers, is monomorphized without per-choice virtual dispatch.
+
+pub fn play_to_end<'ctype, C1, C2>(
     game_state: &mut GameState<'ctype>,
     mut choice: Choice<'ctype>,
-    p1: &mut dyn PlayerController<'ctype>,
-    p2: &mut dyn PlayerController<'ctype>,
-) -> GameResult {
+    p1: &mut C1,
+    p2: &mut C2,
+) -> GameResult
+where
+    C1: PlayerController<'ctype> + ?Sized,
+    C2: PlayerController<'ctype> + ?Sized,
+{
     loop {
         match do_one_choice(game_state, &choice, p1, p2).1 {
             Ok(new_choice) => choice = new_choice,
@@ -132,22 +141,24 @@ pub fn play_to_end<'ctype>(
     }
 }
 
-fn do_one_choice<'c, 'ctype>(
+fn do_one_choice<'ctype, C1, C2>(
     game_state: &mut GameState<'ctype>,
     choice: &Choice<'ctype>,
-    p1: &'c mut dyn PlayerController<'ctype>,
-    p2: &'c mut dyn PlayerController<'ctype>,
-) -> (usize, Result<Choice<'ctype>, GameResult>) {
-    // get the choosing player and their controller
+    p1: &mut C1,
+    p2: &mut C2,
+) -> (usize, Result<Choice<'ctype>, GameResult>)
+where
+    C1: PlayerController<'ctype> + ?Sized,
+    C2: PlayerController<'ctype> + ?Sized,
+{
+    // get the choosing player and have their controller choose an option
     let chooser = choice.chooser(game_state);
-    let controller = match chooser {
-        Player::Player1 => p1,
-        Player::Player2 => p2,
+    let game_view = game_state.view_for(chooser);
+    let chosen_option = match chooser {
+        Player::Player1 => p1.choose_option(&game_view, choice),
+        Player::Player2 => p2.choose_option(&game_view, choice),
     };
 
-    // have the controller choose an option
-    let chosen_option = controller.choose_option(&game_state.view_for(chooser), choice);
-
     // apply the choice to the game state
     let choice_result = choice.choose(game_state, chosen_option);
 
@@ -1,7 +1,4 @@
-use rand::thread_rng;
 use std::borrow::Cow;
-use std::collections::hash_map::Entry;
-use std::collections::HashMap;
 use std::fmt;
 use std::time::{Duration, Instant};
 use tui::widgets::ListItem;
@@ -10,12 +7,14 @@ use crate::radlands::choices::*;
 use crate::radlands::controllers::monte_carlo::format_stats_prefix;
 use crate::radlands::observed_state::ObservedState;
 use crate::radlands::*;
+use crate::rng::fast_rng;
 use crate::ui;
 
 use super::monte_carlo::{
     compute_rollout_score, format_option_stats, get_best_options, get_score, randomize_unobserved,
     OptionStats, StatsWidget,
 };
+use super::state_table::StateTable;
 
 #[derive(Debug, Clone)]
 struct StateStats {
@@ -46,18 +45,25 @@ pub struct MCTSController<'ctype, F> {
     pub choice_time_limit: Duration,
     pub make_rollout_controller: F,
 
-    explored_states: HashMap<ObservedState<'ctype>, StateStats>,
+    explored_states: StateTable<StateStats>,
     current_ply: u32,
+    phantom: std::marker::PhantomData<&'ctype ()>,
 }
 
 impl<'g, 'ctype: 'g, C: PlayerController<'ctype>, F: Fn(Player) -> C> MCTSController<'ctype, F> {
     pub fn new(player: Player, choice_time_limit: Duration, make_rollout_controller: F) -> Self {
+        // Preallocate the state table for a typical search's worth of nodes,
+        // so the hot search loop doesn't repeatedly pay for rehash-and-grow.
+        // (At ~64 bytes per slot this is a few tens of MB; pruning between
+        // plies keeps the entry count from growing much past this.)
+        const EXPLORED_STATES_CAPACITY: usize = 1 << 18;
         Self {
             player,
             choice_time_limit,
             make_rollout_controller,
-            explored_states: HashMap::new(),
+            explored_states: StateTable::with_capacity(EXPLORED_STATES_CAPACITY),
             current_ply: 0,
+            phantom: std::marker::PhantomData,
         }
     }
 
@@ -70,7 +76,7 @@ impl<'g, 'ctype: 'g, C: PlayerController<'ctype>, F: Fn(Player) -> C> MCTSContro
         let chooser = choice.chooser(game_state);
         let observed_state = ObservedState::from_game_state(game_state, choice, chooser);
         self.explored_states
-            .get(&observed_state)
+            .get(observed_state.fingerprint())
             .map(|stats| (stats.num_rollouts, stats.options.as_slice()))
             .expect("root state not explored")
     }
@@ -134,7 +140,7 @@ impl<'g, 'ctype: 'g, C: PlayerController<'ctype>, F: Fn(Player) -> C> MCTSContro
                 // get the observed state of the game (hash table key)
                 let observed_state = ObservedState::from_game_state(&game_state, &choice, chooser);
 
-                if let Some(stats) = self.explored_states.get(&observed_state) {
+                if let Some(stats) = self.explored_states.get(observed_state.fingerprint()) {
                     if root_count.is_none() {
                         root_count = Some(stats.num_rollouts);
                     }
@@ -164,11 +170,11 @@ impl<'g, 'ctype: 'g, C: PlayerController<'ctype>, F: Fn(Player) -> C> MCTSContro
                 spans.0.splice(
                     0..0,
                     [if let Some((count, visit_proportion, win_rate)) = stats {
-                        format_stats_prefix(count, visit_proportion, *win_rate) + "   "
+                        Span::from(format_stats_prefix(count, visit_proportion, *win_rate) + "   ")
                     } else {
-                        " ".repeat(32) // length of the stats prefix
-                    }
-                    .into()],
+                        // a static blank with the length of the stats prefix
+                        Span::from("                                ")
+                    }],
                 );
                 spans
             }));
@@ -187,7 +193,7 @@ impl<'g, 'ctype: 'g, C: PlayerController<'ctype>, F: Fn(Player) -> C> MCTSContro
         if self.current_ply > PAST_PLIES_TO_KEEP {
             let cutoff_ply = self.current_ply - PAST_PLIES_TO_KEEP;
             self.explored_states
-                .retain(|_, state_stats| state_stats.last_visit_ply >= cutoff_ply);
+                .retain(|state_stats| state_stats.last_visit_ply >= cutoff_ply);
         }
     }
 
@@ -222,13 +228,39 @@ impl<'g, 'ctype: 'g, C: PlayerController<'ctype>, F: Fn(Player) -> C> MCTSContro
             if elapsed > Duration::from_millis(100) {
                 self.show_stats(game_view, choice, num_samples, start_time);
                 last_print_time = now;
+
+                // Early cutoff: the final choice is the most-visited root
+                // option, so once its visit lead over the runner-up exceeds
+                // the number of samples that can still run before the
+                // deadline, further search cannot change the decision.
+                let total_elapsed = now.duration_since(start_time);
+                let samples_per_sec = (num_samples as f64) / total_elapsed.as_secs_f64();
+                let remaining_secs = self
+                    .choice_time_limit
+                    .saturating_sub(total_elapsed)
+                    .as_secs_f64();
+                let (_, options) = self.get_root_option_stats(game_view, choice);
+                let mut best = 0;
+                let mut second = 0;
+                for option_stats in options {
+                    let n = option_stats.num_rollouts;
+                    if n > best {
+                        second = best;
+                        best = n;
+                    } else if n > second {
+                        second = n;
+                    }
+                }
+                if f64::from(best - second) > samples_per_sec * remaining_secs {
+                    break;
+                }
             }
         }
         self.show_stats(game_view, choice, num_samples, start_time);
 
         // return a random best (maximum visit count) choice
         *get_best_options(self.get_root_option_stats(game_view, choice).1)
-            .choose(&mut thread_rng())
+            .choose(&mut fast_rng())
             .unwrap()
     }
 
@@ -239,31 +271,37 @@ impl<'g, 'ctype: 'g, C: PlayerController<'ctype>, F: Fn(Player) -> C> MCTSContro
         game_state: &mut GameState<'ctype>,
         choice: &Choice<'ctype>,
     ) -> (usize, u32) {
-        // immediately continue to the next move if there's only one option
-        let num_options = choice.num_options(game_state);
-        if num_options == 1 {
-            let score = match choice.choose(game_state, 0) {
-                Err(game_result) => get_score(game_result, Player::Player1),
-                Ok(next_choice) => self.sample_move(game_state, &next_choice).1,
-            };
-            return (0, score);
-        }
+        // Fast-forward through single-option choices with a loop instead of
+        // recursion; these forced chains are common and need no tree node or
+        // stack frame apiece.
+        let mut choice = Cow::Borrowed(choice);
+        let num_options = loop {
+            let num_options = choice.num_options(game_state);
+            if num_options != 1 {
+                break num_options;
+            }
+            match choice.choose(game_state, 0) {
+                Err(game_result) => return (0, get_score(game_result, Player::Player1)),
+                Ok(next_choice) => choice = Cow::Owned(next_choice),
+            }
+        };
+        let choice = &*choice;
 
         // get which player needs to make a move
         let chooser = choice.chooser(game_state);
 
         // get the observed state of the game (hash table key)
-        let observed_state = ObservedState::from_game_state(game_state, choice, chooser);
+        let state_key = ObservedState::from_game_state(game_state, choice, chooser).fingerprint();
 
         // sample an option and the score for Player 1
-        let (option_index, rollout_score) = match self.explored_states.entry(observed_state.clone())
-        {
-            Entry::Vacant(entry) => {
+        let (option_index, rollout_score) = match self.explored_states.get_mut(state_key) {
+            None => {
                 // this is the first time we've seen this state, so create a new entry
-                entry.insert(StateStats::new(num_options, self.current_ply));
+                self.explored_states
+                    .insert(state_key, StateStats::new(num_options, self.current_ply));
 
                 // at leaf nodes, start by sampling a random option
-                let first_move = thread_rng().gen_range(0..num_options);
+                let first_move = fast_rng().gen_range(0..num_options);
 
                 // perform a rollout from this state
                 let final_score = compute_rollout_score(
@@ -276,20 +314,14 @@ impl<'g, 'ctype: 'g, C: PlayerController<'ctype>, F: Fn(Player) -> C> MCTSContro
 
                 (first_move, final_score)
             }
-            Entry::Occupied(entry) => {
-                // this state has been seen before; get the stored stats
-                let state_stats = entry.into_mut();
+            Some(state_stats) => {
+                // this state has been seen before; update the stored stats
                 state_stats.last_visit_ply = self.current_ply;
 
                 // choose an option based on the current stats
-                let (option_index, _) = state_stats
-                    .options
-                    .iter()
-                    .enumerate()
-                    .max_by_key(|(_, option_stats)| {
-                        option_stats.puct_score(state_stats.num_rollouts)
-                    })
-                    .unwrap();
+                let option_index = OptionStats::select_max(&state_stats.options, |option_stats| {
+                    option_stats.puct_score(state_stats.num_rollouts)
+                });
 
                 // get the next state and recurse (or return the result if the game ended)
                 let score = match choice.choose(game_state, option_index) {
@@ -302,7 +334,7 @@ impl<'g, 'ctype: 'g, C: PlayerController<'ctype>, F: Fn(Player) -> C> MCTSContro
         };
 
         // update the stats for this option
-        let state_stats = self.explored_states.get_mut(&observed_state).unwrap();
+        let state_stats = self.explored_states.get_mut(state_key).unwrap();
         state_stats.num_rollouts += 1;
         let option_stats = &mut state_stats.options[option_index];
         option_stats.num_rollouts += 1;
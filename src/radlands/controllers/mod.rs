@@ -2,6 +2,7 @@ pub mod human;
 pub mod mcts;
 pub mod monte_carlo;
 pub mod random;
+mod state_table;
 
 use tui::{buffer::Buffer, layout::Rect};
 
@@ -1,6 +1,5 @@
 use ordered_float::NotNan;
 use rand::seq::SliceRandom;
-use rand::thread_rng;
 use std::fmt;
 use std::time::{Duration, Instant};
 use tui::buffer::Buffer;
@@ -11,12 +10,13 @@ use tui::widgets::{List, ListItem, Widget};
 use crate::play_to_end;
 use crate::radlands::choices::*;
 use crate::radlands::*;
+use crate::rng::fast_rng;
 use crate::ui::set_controller_stats;
 
 use super::ControllerStats;
 
 pub fn randomize_unobserved<'ctype>(game_state: &GameState<'ctype>) -> GameState<'ctype> {
-    let mut rng = thread_rng();
+    let mut rng = fast_rng();
     let mut new_game_state = game_state.clone();
 
     // shuffle the deck
@@ -41,19 +41,20 @@ pub fn get_score(game_result: GameResult, for_player: Player) -> u32 {
     }
 }
 
+/// Plays out the game to the end from the given state and returns the score.
+/// The given state must already have its unobserved cards randomized; it is
+/// mutated in place (this avoids a full state copy per rollout).
 pub fn compute_rollout_score<'ctype, C: PlayerController<'ctype>>(
     for_player: Player,
-    game_state: &GameState<'ctype>,
+    game_state: &mut GameState<'ctype>,
     choice: &Choice<'ctype>,
     make_rollout_controller: &impl Fn(Player) -> C,
     option_index: usize,
 ) -> u32 {
-    let mut game_state = randomize_unobserved(game_state);
-
-    let game_result = match choice.choose(&mut game_state, option_index) {
+    let game_result = match choice.choose(game_state, option_index) {
         Err(game_result) => game_result,
         Ok(choice) => play_to_end(
-            &mut game_state,
+            game_state,
             choice,
             &mut (make_rollout_controller)(Player::Player1),
             &mut (make_rollout_controller)(Player::Player2),
@@ -81,16 +82,36 @@ impl OptionStats {
 
     /// The UCB1 score for a choice.
     /// https://gibberblot.github.io/rl-notes/single-agent/multi-armed-bandits.html
-    pub fn ucb1_score(&self, rollout_num: usize) -> NotNan<f64> {
-        self.win_rate() + (2.0 * (rollout_num as f64).ln() / (self.num_rollouts as f64)).sqrt()
+    pub fn ucb1_score(&self, rollout_num: usize) -> f64 {
+        *self.win_rate() + (2.0 * (rollout_num as f64).ln() / (self.num_rollouts as f64)).sqrt()
     }
 
     /// A variant of the PUCT score, similar to that used in AlphaZero.
-    pub fn puct_score(&self, parent_rollouts: u32) -> NotNan<f64> {
+    pub fn puct_score(&self, parent_rollouts: u32) -> f64 {
         let exploration_rate = 1.0; // TODO: make this a tunable parameter
         let exploration_score =
             exploration_rate * (parent_rollouts as f64).sqrt() / ((1 + self.num_rollouts) as f64);
-        self.win_rate() + exploration_score
+        *self.win_rate() + exploration_score
+    }
+
+    /// Returns the index of the option with the highest score, computed by
+    /// `score_fn`. Scores are finite by construction, so this scans with
+    /// plain `f64` comparisons rather than paying for `NotNan` ordering on
+    /// the selection hot path.
+    pub fn select_max(
+        option_stats_vec: &[OptionStats],
+        score_fn: impl Fn(&OptionStats) -> f64,
+    ) -> usize {
+        let mut best_index = 0;
+        let mut best_score = f64::NEG_INFINITY;
+        for (index, option_stats) in option_stats_vec.iter().enumerate() {
+            let score = score_fn(option_stats);
+            if score > best_score {
+                best_score = score;
+                best_index = index;
+            }
+        }
+        best_index
     }
 }
 
@@ -132,14 +153,17 @@ pub fn format_option_stats<'g, 'ctype: 'g>(
 }
 
 pub fn format_stats_prefix(visit_count: u32, visit_proportion: f64, win_rate: f64) -> String {
-    let max_bar_width = 10;
-    let bar_width = visit_proportion * (max_bar_width as f64);
-    let bar_width = (bar_width.round() as usize).clamp(0, max_bar_width);
+    const MAX_BAR_WIDTH: usize = 10;
+    // slice static bar strings instead of allocating with `.repeat()`
+    const DOTS: &str = "..........";
+    const HASHES: &str = "##########";
+    let bar_width = visit_proportion * (MAX_BAR_WIDTH as f64);
+    let bar_width = (bar_width.round() as usize).clamp(0, MAX_BAR_WIDTH);
     format!(
         "{:8}  {}{}  {:6.2}%",
         visit_count,
-        ".".repeat(max_bar_width - bar_width),
-        "#".repeat(bar_width),
+        &DOTS[..MAX_BAR_WIDTH - bar_width],
+        &HASHES[..bar_width],
         win_rate * 100.0,
     )
 }
@@ -202,7 +226,7 @@ impl<'ctype, C: PlayerController<'ctype>, F: Fn(Player) -> C> MonteCarloControll
                 num_rollouts: 1,
                 total_score: compute_rollout_score(
                     self.player,
-                    game_view.game_state,
+                    &mut randomize_unobserved(game_view.game_state),
                     choice,
                     &self.make_rollout_controller,
                     option_index,
@@ -215,18 +239,17 @@ impl<'ctype, C: PlayerController<'ctype>, F: Fn(Player) -> C> MonteCarloControll
         show_option_stats(&option_stats_vec, rollout_num, game_view, choice);
         while start_time.elapsed() < self.choice_time_limit {
             // choose a choice to simulate using UCB1
-            let (option_index, option_stats) = option_stats_vec
-                .iter_mut()
-                .enumerate()
-                .max_by_key(|(_, option_stats)| option_stats.ucb1_score(rollout_num))
-                .unwrap();
+            let option_index = OptionStats::select_max(&option_stats_vec, |option_stats| {
+                option_stats.ucb1_score(rollout_num)
+            });
+            let option_stats = &mut option_stats_vec[option_index];
 
             // perform a rollout for that choice
             rollout_num += 1;
             option_stats.num_rollouts += 1;
             option_stats.total_score += compute_rollout_score(
                 self.player,
-                game_view.game_state,
+                &mut randomize_unobserved(game_view.game_state),
                 choice,
                 &self.make_rollout_controller,
                 option_index,
@@ -244,7 +267,7 @@ impl<'ctype, C: PlayerController<'ctype>, F: Fn(Player) -> C> MonteCarloControll
 
         // return a random best (maximum visit count) choice
         *get_best_options(&option_stats_vec)
-            .choose(&mut thread_rng())
+            .choose(&mut fast_rng())
             .unwrap()
     }
 }
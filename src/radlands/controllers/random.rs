@@ -1,7 +1,8 @@
-use rand::thread_rng;
+use rand::Rng;
 
 use crate::radlands::choices::*;
 use crate::radlands::*;
+use crate::rng::fast_rng;
 
 pub struct RandomController;
 
@@ -11,6 +12,6 @@ impl<'ctype> PlayerController<'ctype> for RandomController {
         game_view: &GameView<'g, 'ctype>,
         choice: &Choice<'ctype>,
     ) -> usize {
-        thread_rng().gen_range(0..choice.num_options(game_view.game_state))
+        fast_rng().gen_range(0..choice.num_options(game_view.game_state))
     }
 }
@@ -0,0 +1,120 @@
+use std::iter;
+use std::mem;
+
+/// A flat, linear-probing hash table keyed by precomputed 64-bit state
+/// fingerprints.
+///
+/// `HashMap` re-hashes the key on every lookup and chases pointers into
+/// separately-allocated buckets. Since an `ObservedState` is already a
+/// well-mixed 64-bit fingerprint, this table just masks it into a
+/// power-of-two slot array and probes linearly, so a lookup on the search
+/// hot path touches only a few contiguous slots.
+pub struct StateTable<V> {
+    /// The slot array. The length is always a power of two.
+    slots: Vec<Option<(u64, V)>>,
+
+    /// The number of occupied slots.
+    len: usize,
+}
+
+impl<V> StateTable<V> {
+    /// Creates a new, empty `StateTable`.
+    #[allow(dead_code)]
+    pub fn new() -> Self {
+        Self::with_capacity(64)
+    }
+
+    /// Creates a new, empty `StateTable` with room for at least `capacity`
+    /// entries before growing.
+    pub fn with_capacity(capacity: usize) -> Self {
+        let num_slots = (capacity * 2).next_power_of_two();
+        Self {
+            slots: iter::repeat_with(|| None).take(num_slots).collect(),
+            len: 0,
+        }
+    }
+
+    /// Returns the number of entries in the table.
+    pub fn len(&self) -> usize {
+        self.len
+    }
+
+    /// Returns the index of the slot containing the given key, or of the
+    /// empty slot where it would be inserted.
+    fn slot_index(&self, key: u64) -> usize {
+        let mask = self.slots.len() - 1;
+        let mut index = (key as usize) & mask;
+        while let Some((existing_key, _)) = &self.slots[index] {
+            if *existing_key == key {
+                break;
+            }
+            index = (index + 1) & mask;
+        }
+        index
+    }
+
+    /// Returns a reference to the value for the given key, if present.
+    pub fn get(&self, key: u64) -> Option<&V> {
+        match &self.slots[self.slot_index(key)] {
+            Some((_, value)) => Some(value),
+            None => None,
+        }
+    }
+
+    /// Returns a mutable reference to the value for the given key, if present.
+    pub fn get_mut(&mut self, key: u64) -> Option<&mut V> {
+        let index = self.slot_index(key);
+        match &mut self.slots[index] {
+            Some((_, value)) => Some(value),
+            None => None,
+        }
+    }
+
+    /// Inserts a value for the given key, replacing any existing value.
+    pub fn insert(&mut self, key: u64, value: V) {
+        // keep the load factor at or below 1/2 so probe chains stay short
+        if (self.len + 1) * 2 > self.slots.len() {
+            self.grow();
+        }
+        let index = self.slot_index(key);
+        if self.slots[index].is_none() {
+            self.len += 1;
+        }
+        self.slots[index] = Some((key, value));
+    }
+
+    /// Keeps only the entries whose values satisfy the given predicate.
+    pub fn retain(&mut self, mut f: impl FnMut(&V) -> bool) {
+        // rebuild the table so that probe chains stay contiguous
+        // (plain linear probing has no tombstones)
+        let num_slots = self.slots.len();
+        let old_slots = mem::replace(
+            &mut self.slots,
+            iter::repeat_with(|| None).take(num_slots).collect(),
+        );
+        self.len = 0;
+        for slot in old_slots {
+            if let Some((key, value)) = slot {
+                if f(&value) {
+                    self.insert(key, value);
+                }
+            }
+        }
+    }
+
+    /// Doubles the size of the slot array, re-inserting all entries.
+    fn grow(&mut self) {
+        let new_num_slots = self.slots.len() * 2;
+        let old_slots = mem::replace(
+            &mut self.slots,
+            iter::repeat_with(|| None).take(new_num_slots).collect(),
+        );
+        self.len = 0;
+        for slot in old_slots.into_iter().flatten() {
+            let (key, value) = slot;
+            let index = self.slot_index(key);
+            self.slots[index] = Some((key, value));
+            self.len += 1;
+        }
+    }
+}
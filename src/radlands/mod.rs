@@ -12,7 +12,7 @@ pub mod styles;
 use by_address::ByAddress;
 use itertools::Itertools;
 use rand::seq::SliceRandom;
-use rand::{thread_rng, Rng};
+use rand::Rng;
 use std::cmp::Ordering;
 use std::hash::{Hash, Hasher};
 use std::mem;
@@ -20,6 +20,7 @@ use tui::text::{Span, Spans};
 
 use crate::cards::Cards;
 use crate::make_spans;
+use crate::rng::fast_rng;
 
 use self::abilities::Ability;
 use self::camps::CampType;
@@ -82,12 +83,10 @@ impl<'g, 'ctype: 'g> GameState<'ctype> {
                 deck.push(PersonOrEventType::Event(event_type));
             }
         }
-        deck.shuffle(&mut thread_rng());
+        deck.shuffle(&mut fast_rng());
 
         // pick 3 camps for each player at random
-        let chosen_camps = camp_types
-            .choose_multiple(&mut thread_rng(), 6)
-            .collect_vec();
+        let chosen_camps = camp_types.choose_multiple(&mut fast_rng(), 6).collect_vec();
         let p1_camps = &chosen_camps[..3];
         let p2_camps = &chosen_camps[3..];
 
@@ -96,8 +95,8 @@ impl<'g, 'ctype: 'g> GameState<'ctype> {
             player2: PlayerState::new(p2_camps, &mut deck),
             deck,
             discard: Vec::new(),
-            cur_player: thread_rng().gen(), // randomly pick which player goes first
-            cur_player_water: 1,            // the first player gets 1 water for the first turn
+            cur_player: fast_rng().gen(), // randomly pick which player goes first
+            cur_player_water: 1,          // the first player gets 1 water for the first turn
             has_paid_to_draw: false,
             has_played_event: false,
             has_reshuffled_deck: false,
@@ -344,7 +343,7 @@ impl<'g, 'ctype: 'g> GameState<'ctype> {
             } else {
                 // reshuffle the discard pile into the deck
                 mem::swap(&mut self.deck, &mut self.discard);
-                self.deck.shuffle(&mut thread_rng());
+                self.deck.shuffle(&mut fast_rng());
                 self.has_reshuffled_deck = true;
             }
         }
@@ -354,11 +353,16 @@ impl<'g, 'ctype: 'g> GameState<'ctype> {
     /// Subtracts the given amount of water from the current player's pool.
     /// Panics if the player does not have enough water.
     pub fn spend_water(&mut self, amount: u32) {
+        // the panic formatting lives in a #[cold] function so this compiles
+        // down to a compare, a branch to cold code, and a subtract
+        #[cold]
+        #[inline(never)]
+        fn insufficient_water(amount: u32, available: u32) -> ! {
+            panic!("Tried to spend {amount} water, but only {available} available");
+        }
+
         if self.cur_player_water < amount {
-            panic!(
-                "Tried to spend {amount} water, but only {} available",
-                self.cur_player_water
-            );
+            insufficient_water(amount, self.cur_player_water);
         }
         self.cur_player_water -= amount;
     }
@@ -1,5 +1,3 @@
-use std::collections::BTreeMap;
-
 use crate::cards::Cards;
 
 use super::choices::Choice;
@@ -8,100 +6,142 @@ use super::locations::Player;
 use super::player_state::CardColumn;
 use super::{GameState, PersonOrEventType};
 
-/// A hashable multiset of cards.
-#[derive(Clone, PartialEq, Eq, Hash, Default)]
-struct HashableCards<'ctype> {
-    cards: BTreeMap<PersonOrEventType<'ctype>, usize>,
-}
-
-impl<'iter, 'ctype: 'iter, I> From<I> for HashableCards<'ctype>
-where
-    I: IntoIterator<Item = &'iter PersonOrEventType<'ctype>>,
-{
-    fn from(iterable: I) -> Self {
-        let mut cards = BTreeMap::new();
-        for card in iterable {
-            cards
-                .entry(*card)
-                .and_modify(|count| *count += 1)
-                .or_insert(1);
-        }
-        HashableCards { cards }
-    }
-}
-
-impl<'ctype> From<&Cards<PersonOrEventType<'ctype>>> for HashableCards<'ctype> {
-    fn from(cards: &Cards<PersonOrEventType<'ctype>>) -> Self {
-        HashableCards {
-            cards: BTreeMap::from_iter(cards.iter()),
-        }
-    }
-}
-
 /// Stores the game state observed by a single player.
+/// `Cards` keeps its counts sorted by card type, so the card multisets here
+/// hash and compare with a linear scan over contiguous memory.
+///
+/// This struct only exists long enough to be hashed into a fingerprint, so
+/// it borrows the hand and columns from the game state rather than cloning
+/// them; only the multisets derived from the deck and discard lists are
+/// built fresh.
 #[derive(Clone, PartialEq, Eq, Hash)]
-pub struct ObservedStateFull<'ctype> {
-    undrawn_cards: HashableCards<'ctype>,
-    discard: HashableCards<'ctype>,
+pub struct ObservedStateFull<'g, 'ctype> {
+    undrawn_cards: Cards<PersonOrEventType<'ctype>>,
+    discard: Cards<PersonOrEventType<'ctype>>,
 
     /// The cards I have in my hand.
-    my_hand: HashableCards<'ctype>,
+    my_hand: &'g Cards<PersonOrEventType<'ctype>>,
     /// The cards I know my opponent has in their hand.
-    opponent_hand_known: HashableCards<'ctype>,
-    /// The number of cards in my opponent's hand whose identity is unknown to me.
-    opponent_hand_unknown_count: usize,
+    opponent_hand_known: Cards<PersonOrEventType<'ctype>>,
 
-    my_columns: [CardColumn<'ctype>; 3],
+    my_columns: &'g [CardColumn<'ctype>; 3],
     my_events: [Option<&'ctype EventType>; 3],
-    opponent_columns: [CardColumn<'ctype>; 3],
+    opponent_columns: &'g [CardColumn<'ctype>; 3],
     opponent_events: [Option<&'ctype EventType>; 3],
 
-    cur_player: Player,
-    cur_player_water: u32,
-    other_player_has_water_silo: bool,
-    has_paid_to_draw: bool,
-    has_played_event: bool,
-    has_reshuffled_deck: bool,
+    /// The remaining small scalar fields of the state, packed into a single
+    /// word (see `pack_scalars`) so that they hash and compare as one u64.
+    packed_scalars: u64,
+
     // TODO: Does this struct need to include the current choice too?
     // I think it just needs to uniquely identify nodes in the game search tree.
     // edit: YES, it needs to include some info about the current choice.
     //       For example, which ability was just selected on Rabble Rouser / Mimic?
     //       Asserting that option counts match should catch issues like this.
     choice_type: std::mem::Discriminant<Choice<'ctype>>,
+}
+
+/// Packs the small scalar fields of an observed state into a single u64.
+#[allow(clippy::too_many_arguments)]
+fn pack_scalars(
+    cur_player: Player,
+    cur_player_water: u32,
+    opponent_hand_unknown_count: usize,
+    other_player_has_water_silo: bool,
+    has_paid_to_draw: bool,
+    has_played_event: bool,
+    has_reshuffled_deck: bool,
     num_options: usize,
+) -> u64 {
+    let flags = [
+        cur_player == Player::Player2,
+        other_player_has_water_silo,
+        has_paid_to_draw,
+        has_played_event,
+        has_reshuffled_deck,
+    ]
+    .iter()
+    .enumerate()
+    .map(|(i, &flag)| u64::from(flag) << i)
+    .sum::<u64>();
+    debug_assert!(cur_player_water < 0x100);
+    debug_assert!(opponent_hand_unknown_count < 0x100);
+    flags
+        | (cur_player_water as u64) << 8
+        | (opponent_hand_unknown_count as u64) << 16
+        | (num_options as u64) << 24
 }
 
-impl<'ctype> ObservedStateFull<'ctype> {
+impl<'g, 'ctype> ObservedStateFull<'g, 'ctype> {
     /// Creates a new `ObservedState` from the given game state.
     pub fn from_game_state(
-        game_state: &GameState<'ctype>,
+        game_state: &'g GameState<'ctype>,
         choice: &Choice<'ctype>,
         player: Player,
     ) -> Self {
         ObservedStateFull {
-            undrawn_cards: (&game_state.deck).into(),
-            discard: (&game_state.discard).into(),
-            my_hand: (&game_state.player(player).hand).into(),
-            opponent_hand_known: HashableCards::default(), // TODO: track known cards
-            opponent_hand_unknown_count: game_state.player(player.other()).hand.count(),
-            my_columns: game_state.player(player).columns.clone(),
+            undrawn_cards: Cards::from_iter(&game_state.deck),
+            discard: Cards::from_iter(&game_state.discard),
+            my_hand: &game_state.player(player).hand,
+            opponent_hand_known: Cards::default(), // TODO: track known cards
+            my_columns: &game_state.player(player).columns,
             my_events: game_state.player(player).events,
-            opponent_columns: game_state.player(player.other()).columns.clone(),
+            opponent_columns: &game_state.player(player.other()).columns,
             opponent_events: game_state.player(player.other()).events,
-            cur_player: game_state.cur_player,
-            cur_player_water: game_state.cur_player_water,
-            other_player_has_water_silo: game_state
-                .player(game_state.cur_player.other())
-                .has_water_silo,
-            has_paid_to_draw: game_state.has_paid_to_draw,
-            has_played_event: game_state.has_played_event,
-            has_reshuffled_deck: game_state.has_reshuffled_deck,
+            packed_scalars: pack_scalars(
+                game_state.cur_player,
+                game_state.cur_player_water,
+                game_state.player(player.other()).hand.count(),
+                game_state
+                    .player(game_state.cur_player.other())
+                    .has_water_silo,
+                game_state.has_paid_to_draw,
+                game_state.has_played_event,
+                game_state.has_reshuffled_deck,
+                choice.num_options(game_state),
+            ),
             choice_type: std::mem::discriminant(choice),
-            num_options: choice.num_options(game_state),
         }
     }
 }
 
+/// A fast non-cryptographic hasher for computing state fingerprints.
+/// Each 64-bit word is folded in with a wyhash-style step (xor with fixed
+/// constants, then a widening multiply whose halves are xored together).
+/// This is much cheaper per word than the default SipHash, which matters
+/// because a fingerprint is computed for every node visited by the search.
+/// Fingerprints are never exposed to untrusted input, so the lack of
+/// HashDoS resistance is fine.
+struct FingerprintHasher {
+    state: u64,
+}
+
+impl std::hash::Hasher for FingerprintHasher {
+    fn write(&mut self, bytes: &[u8]) {
+        // hash 8 bytes at a time, zero-padding the final chunk
+        for chunk in bytes.chunks(8) {
+            let mut buf = [0; 8];
+            buf[..chunk.len()].copy_from_slice(chunk);
+            self.write_u64(u64::from_le_bytes(buf));
+        }
+    }
+
+    fn write_u64(&mut self, word: u64) {
+        const K0: u64 = 0x2d35_8dcc_aa6c_78a5;
+        const K1: u64 = 0x8bb8_4b93_962e_acc9;
+        let product = u128::from(self.state ^ K0) * u128::from(word ^ K1);
+        self.state = (product as u64) ^ ((product >> 64) as u64);
+    }
+
+    fn write_usize(&mut self, n: usize) {
+        self.write_u64(n as u64);
+    }
+
+    fn finish(&self) -> u64 {
+        self.state
+    }
+}
+
 #[derive(Clone, PartialEq, Eq, Hash)]
 pub struct ObservedState<'ctype>(u64, std::marker::PhantomData<&'ctype ()>);
 
@@ -113,8 +153,13 @@ impl<'ctype> ObservedState<'ctype> {
         player: Player,
     ) -> Self {
         use std::hash::{Hash, Hasher};
-        let mut hasher = std::collections::hash_map::DefaultHasher::new();
+        let mut hasher = FingerprintHasher { state: 0 };
         ObservedStateFull::from_game_state(game_state, choice, player).hash(&mut hasher);
         ObservedState(hasher.finish(), std::marker::PhantomData)
     }
+
+    /// Returns the 64-bit fingerprint of the observed state.
+    pub fn fingerprint(&self) -> u64 {
+        self.0
+    }
 }
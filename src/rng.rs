@@ -0,0 +1,41 @@
+use std::cell::RefCell;
+
+use rand::rngs::SmallRng;
+use rand::{RngCore, SeedableRng};
+
+thread_local! {
+    /// A thread-local fast, non-cryptographic generator (xoshiro256++ via
+    /// `SmallRng`).
+    static FAST_RNG: RefCell<SmallRng> = RefCell::new(SmallRng::from_entropy());
+}
+
+/// Returns a handle to a thread-local xoshiro256++ generator.
+///
+/// This is a drop-in replacement for `rand::thread_rng()` in the rollout hot
+/// paths: each draw is a handful of shifts and rotates instead of ThreadRng's
+/// (cryptographic) ChaCha rounds, which matters when shuffling the deck and
+/// picking options millions of times per search.
+pub fn fast_rng() -> FastRng {
+    FastRng
+}
+
+/// A handle to the thread-local fast generator; see [`fast_rng`].
+pub struct FastRng;
+
+impl RngCore for FastRng {
+    fn next_u32(&mut self) -> u32 {
+        FAST_RNG.with(|rng| rng.borrow_mut().next_u32())
+    }
+
+    fn next_u64(&mut self) -> u64 {
+        FAST_RNG.with(|rng| rng.borrow_mut().next_u64())
+    }
+
+    fn fill_bytes(&mut self, dest: &mut [u8]) {
+        FAST_RNG.with(|rng| rng.borrow_mut().fill_bytes(dest))
+    }
+
+    fn try_fill_bytes(&mut self, dest: &mut [u8]) -> Result<(), rand::Error> {
+        FAST_RNG.with(|rng| rng.borrow_mut().try_fill_bytes(dest))
+    }
+}